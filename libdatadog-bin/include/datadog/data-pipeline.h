@@ -30,9 +30,19 @@ typedef enum ddog_TraceExporterInputFormat {
  */
 typedef enum ddog_TraceExporterOutputFormat {
   DDOG_TRACE_EXPORTER_OUTPUT_FORMAT_V04,
+  /**
+   * When the input format is V0.4, traces are transcoded in a single streaming pass: strings are
+   * borrowed from the input buffer and deduplicated into the v0.7 string table as they are read,
+   * without decoding spans into owned objects first.
+   */
   DDOG_TRACE_EXPORTER_OUTPUT_FORMAT_V07,
 } ddog_TraceExporterOutputFormat;
 
+/**
+ * Builds traces span by span directly into a msgpack buffer, see `ddog_trace_builder_new`.
+ */
+typedef struct ddog_TraceBuilder ddog_TraceBuilder;
+
 typedef struct ddog_TraceExporter ddog_TraceExporter;
 
 /**
@@ -108,6 +118,283 @@ typedef struct ddog_Slice_U8 {
  */
 typedef struct ddog_Slice_U8 ddog_ByteSlice;
 
+/**
+ * Configuration of the TraceExporter's in-memory buffer, see
+ * `ddog_trace_exporter_enable_buffering`.
+ */
+typedef struct ddog_TraceExporterBufferConfig {
+  /**
+   * Traces enqueued while the buffer holds this many bytes are dropped.
+   */
+  uintptr_t max_buffer_bytes;
+  /**
+   * The background thread flushes once the buffer holds this many bytes.
+   */
+  uintptr_t flush_size_bytes;
+  /**
+   * The background thread flushes at least this often, if anything is buffered.
+   */
+  uint64_t flush_interval_ms;
+  /**
+   * Longest time `ddog_trace_exporter_free` waits for the buffered traces to
+   * be sent before dropping the rest. Zero means 1000.
+   */
+  uint64_t shutdown_timeout_ms;
+} ddog_TraceExporterBufferConfig;
+
+/**
+ * Counters of the TraceExporter's buffer since buffering was enabled, see
+ * `ddog_trace_exporter_buffer_counters`.
+ */
+typedef struct ddog_TraceExporterBufferCounters {
+  uint64_t enqueued_traces;
+  uint64_t dropped_traces;
+  uint64_t dropped_bytes;
+  uint64_t flushes;
+  uint64_t failed_flushes;
+} ddog_TraceExporterBufferCounters;
+
+/**
+ * A snapshot of the TraceExporter's state, see `ddog_trace_exporter_stats`.
+ */
+typedef struct ddog_TraceExporterStats {
+  /**
+   * Bytes waiting in the buffer, if buffering is enabled.
+   */
+  uintptr_t queued_bytes;
+  /**
+   * Traces waiting in the buffer, if buffering is enabled.
+   */
+  uintptr_t queued_traces;
+  /**
+   * HTTP requests to the agent currently awaiting a response, counting each
+   * chunk of a chunked send, and span stats payloads.
+   */
+  uintptr_t requests_in_flight;
+  /**
+   * HTTP requests that got a response from the agent, whatever its status,
+   * counted the same way as `requests_in_flight`.
+   */
+  uint64_t requests_sent;
+  /**
+   * Bytes of the bodies of `requests_sent`, as put on the wire.
+   */
+  uint64_t bytes_sent;
+  /**
+   * Exponentially weighted moving average of the send latency, from the start
+   * of a request to the end of its response.
+   */
+  uint64_t send_latency_avg_us;
+  /**
+   * Largest send latency observed, measured as for `send_latency_avg_us`.
+   */
+  uint64_t send_latency_max_us;
+  /**
+   * Requests answered by the agent with an error status.
+   */
+  uint64_t agent_errors;
+  /**
+   * Requests that failed without an answer from the agent, e.g. timeouts.
+   */
+  uint64_t transport_errors;
+  /**
+   * Traces the sampler decided not to keep. They are still sent, unless they
+   * are also counted in `dropped_unsampled_traces`.
+   */
+  uint64_t sampled_out_traces;
+  /**
+   * Unsampled traces not sent because span stats are enabled with
+   * `drop_unsampled_traces`.
+   */
+  uint64_t dropped_unsampled_traces;
+  struct ddog_TraceExporterBufferCounters buffer;
+} ddog_TraceExporterStats;
+
+/**
+ * Configuration of payload chunking, see `ddog_trace_exporter_set_chunking`.
+ */
+typedef struct ddog_TraceExporterChunkingConfig {
+  /**
+   * Payloads are split at trace boundaries so that none exceeds this size,
+   * except for a single trace bigger than it, which is sent on its own.
+   */
+  uintptr_t max_payload_bytes;
+  /**
+   * Number of chunks that may be in flight at the same time, each on its own
+   * connection from the TraceExporter's pool. Zero means 1, i.e. chunks are
+   * sent one after the other.
+   */
+  uintptr_t max_concurrent_requests;
+} ddog_TraceExporterChunkingConfig;
+
+/**
+ * Configuration of the normalization and obfuscation stage, see
+ * `ddog_trace_exporter_set_obfuscation`.
+ */
+typedef struct ddog_TraceObfuscationConfig {
+  /**
+   * Normalize spans as the agent does: truncate and sanitize service, name,
+   * resource and type, fill in missing ones, and fix invalid durations.
+   */
+  bool normalize;
+  /**
+   * Replace literals in the resource of `sql` and `cassandra` spans with `?`.
+   */
+  bool obfuscate_sql;
+  /**
+   * Replace the arguments in the `redis.raw_command` tag of `redis` spans
+   * with `?`, keeping the command names. The resource is left as-is.
+   */
+  bool obfuscate_redis;
+  /**
+   * Remove the stored value from the `memcached.command` tag of `memcached`
+   * spans, keeping the command and keys. The resource is left as-is.
+   */
+  bool obfuscate_memcached;
+  /**
+   * Remove the query string from `http.url`.
+   */
+  bool obfuscate_http_query_string;
+  /**
+   * Replace path segments containing digits in `http.url` with `?`.
+   */
+  bool quantize_http_path_digits;
+} ddog_TraceObfuscationConfig;
+
+/**
+ * Configuration of client-side span stats, see `ddog_trace_exporter_enable_span_stats`.
+ */
+typedef struct ddog_TraceExporterSpanStatsConfig {
+  ddog_CharSlice hostname;
+  ddog_CharSlice env;
+  ddog_CharSlice app_version;
+  /**
+   * Duration of the aggregation buckets; the agent expects 10 seconds.
+   * Zero means 10000.
+   */
+  uint64_t bucket_duration_ms;
+  /**
+   * Drop traces whose sampling priority is zero or less once they have been
+   * accounted for in stats, instead of sending them to the agent.
+   */
+  bool drop_unsampled_traces;
+} ddog_TraceExporterSpanStatsConfig;
+
+/**
+ * A trace sampling rule. It matches a trace when its root span matches all of
+ * the non-empty glob patterns (`*` and `?` are supported).
+ */
+typedef struct ddog_TraceSamplingRule {
+  ddog_CharSlice service;
+  ddog_CharSlice name;
+  ddog_CharSlice resource;
+  /**
+   * Rate, between 0 and 1, at which matching traces are kept.
+   */
+  double sample_rate;
+} ddog_TraceSamplingRule;
+
+typedef struct ddog_Slice_TraceSamplingRule {
+  /**
+   * Must be non-null and suitably aligned for the underlying type.
+   */
+  const struct ddog_TraceSamplingRule *ptr;
+  /**
+   * The number of elements (not bytes) that `.ptr` points to. Must be less
+   * than or equal to [isize::MAX].
+   */
+  uintptr_t len;
+} ddog_Slice_TraceSamplingRule;
+
+typedef enum ddog_Option_F64_Tag {
+  DDOG_OPTION_F64_SOME_F64,
+  DDOG_OPTION_F64_NONE_F64,
+} ddog_Option_F64_Tag;
+
+typedef struct ddog_Option_F64 {
+  ddog_Option_F64_Tag tag;
+  union {
+    struct {
+      double some;
+    };
+  };
+} ddog_Option_F64;
+
+/**
+ * Configuration of the TraceExporter's sampler, see `ddog_trace_exporter_set_sampler`.
+ *
+ * Beware of zero-initializing it: the first variant of `ddog_Option_F64_Tag` is
+ * `DDOG_OPTION_F64_SOME_F64`, so a zeroed config has a default sample rate and a
+ * rate limit of 0.0, and samples out every trace no rule keeps. Set the tags of the
+ * optional fields to `DDOG_OPTION_F64_NONE_F64` to get the defaults.
+ */
+typedef struct ddog_TraceSamplerConfig {
+  /**
+   * Evaluated in order; the first matching rule decides.
+   */
+  struct ddog_Slice_TraceSamplingRule rules;
+  /**
+   * Rate applied to traces no rule matched. If None, the rates by service
+   * returned by the agent are used instead.
+   */
+  struct ddog_Option_F64 default_sample_rate;
+  /**
+   * Maximum number of traces per second kept because of rules or
+   * `default_sample_rate`. If None, there is no limit. As in Datadog tracers,
+   * zero keeps none of them. Negative values make
+   * `ddog_trace_exporter_set_sampler` return an error.
+   */
+  struct ddog_Option_F64 rate_limit;
+} ddog_TraceSamplerConfig;
+
+/**
+ * A sampling rate from the `rate_by_service` field of the agent responses.
+ * The fallback rate, keyed "service:,env:" by the agent, has an empty service and env.
+ */
+typedef struct ddog_AgentServiceRate {
+  ddog_CharSlice service;
+  ddog_CharSlice env;
+  double rate;
+} ddog_AgentServiceRate;
+
+typedef struct ddog_Slice_AgentServiceRate {
+  /**
+   * Must be non-null and suitably aligned for the underlying type.
+   */
+  const struct ddog_AgentServiceRate *ptr;
+  /**
+   * The number of elements (not bytes) that `.ptr` points to. Must be less
+   * than or equal to [isize::MAX].
+   */
+  uintptr_t len;
+} ddog_Slice_AgentServiceRate;
+
+/**
+ * The fixed fields of a span, see `ddog_trace_builder_add_span`.
+ */
+typedef struct ddog_SpanFields {
+  ddog_CharSlice service;
+  ddog_CharSlice name;
+  ddog_CharSlice resource;
+  ddog_CharSlice type_;
+  /**
+   * Lower 64 bits of the trace id. The upper 64 bits of a 128-bit trace id go in the `_dd.p.tid`
+   * meta of the first span, as a hex string.
+   */
+  uint64_t trace_id;
+  uint64_t span_id;
+  /**
+   * Zero for the root span.
+   */
+  uint64_t parent_id;
+  /**
+   * Start time in nanoseconds since the Unix Epoch.
+   */
+  int64_t start;
+  int64_t duration;
+  int32_t error;
+} ddog_SpanFields;
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -118,7 +405,8 @@ extern "C" {
  * # Arguments
  *
  * * `out_handle` - The handle to write the TraceExporter instance in.
- * * `url` - The URL of the Datadog Agent to communicate with.
+ * * `url` - The URL of the Datadog Agent to communicate with, e.g. "http://localhost:8126" or,
+ *   to use a Unix Domain Socket, "unix:///var/run/datadog/apm.socket".
  * * `tracer_version` - The version of the client library.
  * * `language` - The language of the client library.
  * * `language_version` - The version of the language of the client library.
@@ -129,7 +417,9 @@ extern "C" {
  *   Proxy input format, this should be set to format if the trace data that will be passed through
  *   as is.
  * * `agent_response_callback` - The callback into the client library that the TraceExporter uses
- *   for updated Agent JSON responses.
+ *   for updated Agent JSON responses. Only invoked when the response body differs from the
+ *   previous one. Can be null, e.g. when using `ddog_trace_exporter_set_rates_callback` or
+ *   `ddog_trace_exporter_get_service_rate` instead.
  */
 ddog_MaybeError ddog_trace_exporter_new(struct ddog_TraceExporter **out_handle,
                                         ddog_CharSlice url,
@@ -143,6 +433,10 @@ ddog_MaybeError ddog_trace_exporter_new(struct ddog_TraceExporter **out_handle,
 
 /**
  * Free the TraceExporter instance.
+ * Before returning, traces still buffered (if buffering is enabled) and then the
+ * current span stats bucket (if span stats are enabled) are sent, waiting at
+ * most `shutdown_timeout_ms` of the buffer config in total, or 1 second if
+ * buffering is not enabled. Whatever is left after that is discarded.
  *
  * # Arguments
  *
@@ -157,13 +451,323 @@ void ddog_trace_exporter_free(struct ddog_TraceExporter *handle);
  *
  * * `handle` - The handle to the TraceExporter instance.
  * * `trace` - The traces to send to the Datadog Agent in the input format used to create the
- *   TraceExporter.
+ *   TraceExporter. Only borrowed for the duration of the call, including when it is transcoded to
+ *   another output format.
  * * `trace_count` - The number of traces to send to the Datadog Agent.
+ *
+ * If chunking is set with `ddog_trace_exporter_set_chunking`, the traces may be sent as several
+ * requests; this returns once all of them completed, with the first error if any failed. Some
+ * traces may then have been accepted by the agent; use `ddog_trace_exporter_send_tracked` to
+ * know which ones, so as not to send them twice when retrying.
  */
 ddog_MaybeError ddog_trace_exporter_send(const struct ddog_TraceExporter *handle,
                                          ddog_ByteSlice trace,
                                          uintptr_t trace_count);
 
+/**
+ * Send traces to the Datadog Agent like `ddog_trace_exporter_send`, also reporting which traces
+ * were accepted by the agent when the traces are sent as several chunks and only some of them
+ * fail.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `trace` - The traces to send to the Datadog Agent in the input format used to create the
+ *   TraceExporter.
+ * * `trace_count` - The number of traces to send to the Datadog Agent.
+ * * `out_sent` - Must point to `trace_count` writable elements. Set to true for each trace, in
+ *   input order, whose chunk was accepted by the agent, and to false otherwise. Written whether or
+ *   not an error is returned.
+ */
+ddog_MaybeError ddog_trace_exporter_send_tracked(const struct ddog_TraceExporter *handle,
+                                                 ddog_ByteSlice trace,
+                                                 uintptr_t trace_count,
+                                                 bool *out_sent);
+
+/**
+ * Make the TraceExporter own a bounded in-memory buffer, flushed to the Datadog Agent by a
+ * background thread, so that traces can be submitted with `ddog_trace_exporter_enqueue` without
+ * waiting on the agent. Must be called at most once, before any enqueue.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `config` - The size limit and flush triggers of the buffer.
+ */
+ddog_MaybeError ddog_trace_exporter_enable_buffering(struct ddog_TraceExporter *handle,
+                                                     struct ddog_TraceExporterBufferConfig config);
+
+/**
+ * Copy traces into the TraceExporter's buffer, to be sent by the background thread. This never
+ * blocks on the network.
+ *
+ * Returns false if the traces were dropped, either because the buffer is full or because buffering
+ * is not enabled. Dropped traces are counted in `ddog_trace_exporter_buffer_counters`.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `trace` - The traces to enqueue, in the input format used to create the TraceExporter.
+ * * `trace_count` - The number of traces in `trace`.
+ */
+bool ddog_trace_exporter_enqueue(const struct ddog_TraceExporter *handle,
+                                 ddog_ByteSlice trace,
+                                 uintptr_t trace_count);
+
+/**
+ * Send everything currently buffered and wait for it to be sent, or for `timeout_ms` to elapse.
+ * Does nothing and returns no error if buffering is not enabled.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `timeout_ms` - How long to wait before returning an error.
+ */
+ddog_MaybeError ddog_trace_exporter_flush(const struct ddog_TraceExporter *handle,
+                                          uint64_t timeout_ms);
+
+/**
+ * Set how long idle connections to the Datadog Agent are kept open. Connections, whether TCP or
+ * Unix Domain Socket, are kept in a pool and reused across sends, so that a connection is not
+ * opened for every request. The default is 30 seconds.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `idle_timeout_ms` - How long a connection may stay unused before being closed. Zero disables
+ *   connection reuse.
+ */
+ddog_MaybeError ddog_trace_exporter_set_connection_idle_timeout(struct ddog_TraceExporter *handle,
+                                                                uint64_t idle_timeout_ms);
+
+/**
+ * Make the TraceExporter split the traces it sends into size-bounded payloads, sent concurrently,
+ * to keep each request under the agent's payload limit and bound per-request latency. Applies to
+ * `ddog_trace_exporter_send`, builder sends and buffered flushes. Ignored with the Proxy input
+ * format, whose payloads are sent as is.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `config` - The chunking configuration. A zero `max_payload_bytes` disables chunking.
+ */
+ddog_MaybeError ddog_trace_exporter_set_chunking(struct ddog_TraceExporter *handle,
+                                                 struct ddog_TraceExporterChunkingConfig config);
+
+/**
+ * Make the TraceExporter normalize spans and obfuscate resources before sending them, instead of
+ * leaving that to the Datadog Agent. Each resource is scanned once, without backtracking, by a
+ * tokenizer working on bytes. Payloads are then sent with the `Datadog-Obfuscation-Version`
+ * header, so that the agent skips these steps. Span stats, if enabled, are computed on the
+ * obfuscated resources, as the agent would.
+ *
+ * Not applied with the Proxy input format, whose payloads are sent as is.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `config` - Which steps to perform. All false disables the stage, which is the default.
+ */
+ddog_MaybeError ddog_trace_exporter_set_obfuscation(struct ddog_TraceExporter *handle,
+                                                    struct ddog_TraceObfuscationConfig config);
+
+/**
+ * Make the TraceExporter compute span stats (trace metrics) itself instead of leaving it to the
+ * Datadog Agent. Hit, error and top-level counts and DDSketch latency distributions are aggregated
+ * per service, resource, operation name, span type and HTTP status code over buckets of
+ * `bucket_duration_ms`, and sent to the agent's stats endpoint. Traces are then sent with the
+ * `Datadog-Client-Computed-Stats` header so that the agent skips computing them.
+ *
+ * Must be called at most once, before sending any traces. Returns an error with the Proxy input
+ * format, whose payloads are not decoded and thus can't be aggregated.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `config` - The span stats configuration.
+ */
+ddog_MaybeError ddog_trace_exporter_enable_span_stats(struct ddog_TraceExporter *handle,
+                                                      struct ddog_TraceExporterSpanStatsConfig config);
+
+/**
+ * Make the TraceExporter take sampling decisions itself, before traces are serialized, instead of
+ * shipping every trace it is handed.
+ *
+ * Traces whose root span already has a sampling priority (`_sampling_priority_v1`) keep it, e.g.
+ * those with a decision propagated from upstream. Other traces are sampled with, in order of
+ * precedence, the rules, the default rate and the rates by service from the agent responses; the
+ * rate limiter applies to the first two. The decision is recorded on the root span as
+ * `_sampling_priority_v1` along with `_dd.rule_psr`, `_dd.limit_psr` or `_dd.agent_psr`.
+ * Traces sampled out are still sent, with their priority, so that the agent can compute stats
+ * from them; when span stats are enabled with `drop_unsampled_traces`, they are instead dropped
+ * before being serialized.
+ *
+ * Can be called again to replace the configuration, e.g. after a remote config update. Returns an
+ * error with the Proxy input format, whose payloads are sent as is and can't be inspected.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `config` - The sampler configuration. Strings are copied and don't need to outlive the call.
+ */
+ddog_MaybeError ddog_trace_exporter_set_sampler(struct ddog_TraceExporter *handle,
+                                                struct ddog_TraceSamplerConfig config);
+
+/**
+ * Set a callback invoked with the parsed rates by service whenever an agent response changes
+ * them. Responses are parsed once by the TraceExporter, and compared to the previous rates, so
+ * client libraries don't need to parse the JSON after every send.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `callback` - Called from the thread that sent the traces. The rates are only borrowed for the
+ *   duration of the call. Passing null removes the callback.
+ * * `user_data` - Passed as is to `callback`.
+ */
+ddog_MaybeError ddog_trace_exporter_set_rates_callback(struct ddog_TraceExporter *handle,
+                                                       void (*callback)(struct ddog_Slice_AgentServiceRate rates,
+                                                                        void *user_data),
+                                                       void *user_data);
+
+/**
+ * Look up the latest agent rate for a service and env, falling back to the agent's default rate.
+ * The rates are kept in a table that is swapped atomically when a response changes them, so this
+ * is lock-free and cheap enough to call for every trace.
+ *
+ * Returns false, leaving `out_rate` untouched, if no agent response provided rates yet.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ * * `service` - The service of the trace's root span.
+ * * `env` - The env of the trace's root span.
+ * * `out_rate` - Where to write the rate.
+ */
+bool ddog_trace_exporter_get_service_rate(const struct ddog_TraceExporter *handle,
+                                          ddog_CharSlice service,
+                                          ddog_CharSlice env,
+                                          double *out_rate);
+
+/**
+ * Create a TraceBuilder for the given TraceExporter. Spans added to the builder are encoded
+ * directly into a msgpack buffer owned by the builder, in the output format of the TraceExporter,
+ * so that client libraries don't need their own encoder nor intermediate span structures. With
+ * the V0.7 output format, strings are interned into the payload's string table as they are added;
+ * V0.4 has no string table, so strings are written inline. Works regardless of the input format
+ * the TraceExporter was created with.
+ *
+ * A builder is meant to be used from a single thread; use one per thread to build traces
+ * concurrently. It must be freed before the TraceExporter.
+ *
+ * # Arguments
+ *
+ * * `out_builder` - The handle to write the TraceBuilder instance in.
+ * * `handle` - The handle to the TraceExporter instance.
+ */
+ddog_MaybeError ddog_trace_builder_new(struct ddog_TraceBuilder **out_builder,
+                                       const struct ddog_TraceExporter *handle);
+
+/**
+ * Free the TraceBuilder instance, discarding traces that were not sent.
+ *
+ * # Arguments
+ *
+ * * `builder` - The handle to the TraceBuilder instance.
+ */
+void ddog_trace_builder_free(struct ddog_TraceBuilder *builder);
+
+/**
+ * Start a new trace. Spans added afterwards belong to it until `ddog_trace_builder_finish_trace`.
+ *
+ * # Arguments
+ *
+ * * `builder` - The handle to the TraceBuilder instance.
+ */
+ddog_MaybeError ddog_trace_builder_start_trace(struct ddog_TraceBuilder *builder);
+
+/**
+ * Append a span to the current trace. Subsequent meta and metrics apply to this span, until the
+ * next span is added.
+ *
+ * # Arguments
+ *
+ * * `builder` - The handle to the TraceBuilder instance.
+ * * `span` - The fixed fields of the span. Strings are copied and don't need to outlive the call.
+ */
+ddog_MaybeError ddog_trace_builder_add_span(struct ddog_TraceBuilder *builder,
+                                            const struct ddog_SpanFields *span);
+
+/**
+ * Add a string tag to the last added span.
+ *
+ * # Arguments
+ *
+ * * `builder` - The handle to the TraceBuilder instance.
+ * * `key` - The key of the tag.
+ * * `value` - The value of the tag.
+ */
+ddog_MaybeError ddog_trace_builder_add_meta(struct ddog_TraceBuilder *builder,
+                                            ddog_CharSlice key,
+                                            ddog_CharSlice value);
+
+/**
+ * Add a numeric tag to the last added span.
+ *
+ * # Arguments
+ *
+ * * `builder` - The handle to the TraceBuilder instance.
+ * * `key` - The key of the metric.
+ * * `value` - The value of the metric.
+ */
+ddog_MaybeError ddog_trace_builder_add_metric(struct ddog_TraceBuilder *builder,
+                                              ddog_CharSlice key,
+                                              double value);
+
+/**
+ * Finish the current trace, which will be part of the next `ddog_trace_exporter_send_builder`.
+ * Returns an error if the trace has no spans.
+ *
+ * # Arguments
+ *
+ * * `builder` - The handle to the TraceBuilder instance.
+ */
+ddog_MaybeError ddog_trace_builder_finish_trace(struct ddog_TraceBuilder *builder);
+
+/**
+ * Send the traces finished in the builder to the Datadog Agent, then reset the builder for reuse,
+ * keeping its buffer allocated. A trace started but not finished is kept for the next send.
+ * If buffering is enabled, the traces are enqueued instead, as with `ddog_trace_exporter_enqueue`.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance the builder was created for.
+ * * `builder` - The handle to the TraceBuilder instance.
+ */
+ddog_MaybeError ddog_trace_exporter_send_builder(const struct ddog_TraceExporter *handle,
+                                                 struct ddog_TraceBuilder *builder);
+
+/**
+ * Get the counters of the TraceExporter's buffer. All zeros if buffering is not enabled.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ */
+struct ddog_TraceExporterBufferCounters ddog_trace_exporter_buffer_counters(const struct ddog_TraceExporter *handle);
+
+/**
+ * Get a snapshot of the TraceExporter's queue, requests and errors, e.g. to adapt sampling when
+ * the pipeline is saturated. Counters are read with relaxed atomics: this never blocks and is
+ * cheap enough to call on every trace, but the fields are not guaranteed to be consistent with
+ * each other. Counters are cumulative since the creation of the TraceExporter.
+ *
+ * # Arguments
+ *
+ * * `handle` - The handle to the TraceExporter instance.
+ */
+struct ddog_TraceExporterStats ddog_trace_exporter_stats(const struct ddog_TraceExporter *handle);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
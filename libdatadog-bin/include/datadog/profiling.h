@@ -12,18 +12,66 @@
 #include <stdint.h>
 #include "common.h"
 
+/**
+ * Bucket 0 counts operations that took [0, 1) us; bucket `i` > 0 counts those
+ * that took [2^(i-1), 2^i) us. The last bucket also counts all longer ones.
+ */
+#define ddog_prof_ProfilingOpStats_HISTOGRAM_BUCKETS 24
+
+/**
+ * Encoding of the crash report emitted by the receiver or by
+ * `ddog_crashinfo_upload_to_endpoint`.
+ */
+typedef enum ddog_prof_CrashReportFormat {
+  /**
+   * Uncompressed `CrashInfo` json. This is the default.
+   */
+  DDOG_PROF_CRASH_REPORT_FORMAT_JSON,
+  /**
+   * Zstd-compressed binary format, in the spirit of minidumps. Modules are
+   * stored once in a table (deduplicating /proc/self/maps entries and the
+   * frames' module base addresses), and frames refer to them by index.
+   * The report is encoded and compressed while streaming, so memory use is
+   * bounded regardless of the number of threads or mappings.
+   *
+   * The agent and intake don't accept this format, so it is only supported
+   * with file endpoints, e.g. for an out-of-process shipper; initializing the
+   * crashtracker or uploading with another endpoint returns an error.
+   */
+  DDOG_PROF_CRASH_REPORT_FORMAT_COMPACT,
+} ddog_prof_CrashReportFormat;
+
 typedef enum ddog_prof_DemangleOptions {
   DDOG_PROF_DEMANGLE_OPTIONS_COMPLETE,
   DDOG_PROF_DEMANGLE_OPTIONS_NAME_ONLY,
 } ddog_prof_DemangleOptions;
 
+/**
+ * How requests sent to a file endpoint are laid out in the output file.
+ */
+typedef enum ddog_prof_Exporter_FileFraming {
+  /**
+   * Each file holds a single request, written as the raw HTTP request that
+   * would have been sent to the agent. The file is rotated before every
+   * request. This is the default.
+   */
+  DDOG_PROF_EXPORTER_FILE_FRAMING_HTTP,
+  /**
+   * Requests are appended to the current file, each one as a frame made of:
+   * * the value of the request's Content-Type header, which carries the
+   *   multipart boundary, as a little-endian u32 length followed by its bytes;
+   * * the multipart body, as a little-endian u64 length followed by its bytes.
+   */
+  DDOG_PROF_EXPORTER_FILE_FRAMING_LENGTH_PREFIXED,
+} ddog_prof_Exporter_FileFraming;
+
 /**
  * This enum represents operations a profiler might be engaged in.
  * The idea is that if a crash consistently occurs while a particular operation
  * is ongoing, its likely related.
  *
- * In the future, we might also track wall-clock time of operations
- * (or some statistical sampling thereof) using the same enum.
+ * The wall-clock time of operations is also tracked using the same enum,
+ * see `ddog_prof_Crashtracker_profiling_op_stats`.
  *
  * NOTE: This enum is known to be non-exhaustive.  Feel free to add new types
  *       as needed.
@@ -52,18 +100,42 @@ typedef enum ddog_prof_StacktraceCollection {
    */
   DDOG_PROF_STACKTRACE_COLLECTION_DISABLED,
   DDOG_PROF_STACKTRACE_COLLECTION_WITHOUT_SYMBOLS,
+  /**
+   * Raw frames (ip, sp, module base) are sent to the receiver first, then
+   * symbols are resolved in the crashing process and streamed frame by frame
+   * until `resolve_frames_budget_ms` elapses. Frames left unresolved are
+   * reported without names.
+   */
   DDOG_PROF_STACKTRACE_COLLECTION_ENABLED_WITH_INPROCESS_SYMBOLS,
+  /**
+   * Symbols are resolved by the receiver, using an on-disk symbol cache when
+   * `symbol_cache` is set, in the `ddog_prof_CrashtrackerReceiverConfig` of a
+   * forked receiver or in the `ddog_prof_CrashtrackerDaemonConfig` of a shared
+   * one.
+   */
   DDOG_PROF_STACKTRACE_COLLECTION_ENABLED_WITH_SYMBOLS_IN_RECEIVER,
 } ddog_prof_StacktraceCollection;
 
 typedef struct ddog_CancellationToken ddog_CancellationToken;
 
+/**
+ * Demangles batches of names into an arena it owns, caching the results so
+ * that names seen in previous batches are not demangled again.
+ */
+typedef struct ddog_prof_Demangler ddog_prof_Demangler;
+
 typedef struct ddog_prof_Exporter ddog_prof_Exporter;
 
 typedef struct ddog_prof_ProfiledEndpointsStats ddog_prof_ProfiledEndpointsStats;
 
 typedef struct ddog_prof_Exporter_Request ddog_prof_Exporter_Request;
 
+/**
+ * Sends requests from a background thread so that the caller can build (and
+ * compress) the next request while the previous one is still on the wire.
+ */
+typedef struct ddog_prof_Exporter_Pipeline ddog_prof_Exporter_Pipeline;
+
 typedef struct ddog_Tag ddog_Tag;
 
 /**
@@ -167,9 +239,97 @@ typedef struct ddog_prof_Endpoint {
   };
 } ddog_prof_Endpoint;
 
+/**
+ * Opt-in collection of the stacks of every thread of the crashing process,
+ * not just the crashing one.
+ *
+ * The handler signals each thread with `signum`, and each thread unwinds its
+ * own stack into a buffer preallocated at init in the crash arena, so
+ * collection is async-signal-safe and threads are unwound concurrently.
+ * Threads that haven't finished within `budget_ms` are reported as missing.
+ * The receiver assembles the stacks into the report, each one under its
+ * thread id.
+ *
+ * The handler for `signum` is only installed once a crash occurs, replacing
+ * any handler the application or profiler installed for it, which is never
+ * restored since the process is about to die. Don't use a signal that may
+ * still be delivered for other reasons at that point, e.g. SIGPROF while the
+ * profiler is running.
+ */
+typedef struct ddog_prof_AllThreadsCollection {
+  bool enabled;
+  /**
+   * Threads beyond this number are not collected. Zero means 256.
+   */
+  uint32_t max_threads;
+  /**
+   * Zero means 128.
+   */
+  uint32_t max_frames_per_thread;
+  /**
+   * Zero means 1000.
+   */
+  uint64_t budget_ms;
+  /**
+   * Signal sent to each thread. Zero means SIGRTMIN + 1 on Linux, and
+   * SIGUSR2 on other platforms.
+   */
+  int32_t signum;
+} ddog_prof_AllThreadsCollection;
+
+/**
+ * Deduplication and rate limiting of crash reports, done by the receiver.
+ *
+ * Crashes are fingerprinted from the signal, the top `fingerprint_frames`
+ * frames and the build ID of the main binary. A crash whose fingerprint was
+ * already uploaded less than `window_secs` ago is not uploaded. Neither is a
+ * crash that would exceed `max_uploads_per_minute`. In both cases, the crash
+ * is added to a pending count kept for its fingerprint. The next uploaded
+ * report, whatever its fingerprint, carries the pending counts of all
+ * fingerprints as counters, which are then reset. Counts still pending when
+ * no further crash is uploaded are not reported.
+ */
+typedef struct ddog_prof_CrashDeduplication {
+  /**
+   * Zero disables deduplication.
+   */
+  uint64_t window_secs;
+  /**
+   * Zero fingerprints crashes from the signal and build ID only.
+   */
+  uint32_t fingerprint_frames;
+  /**
+   * Zero disables rate limiting.
+   */
+  uint32_t max_uploads_per_minute;
+  /**
+   * Directory holding the fingerprints and rate limiter state, so that
+   * consecutive receivers share them. Not needed when a single receiver is
+   * shared through `ddog_prof_Crashtracker_init_with_unix_socket`.
+   *
+   * Many receivers may update the state at the same moment. Each one takes an
+   * advisory lock on a lock file in the directory for the whole
+   * read-decide-update sequence, and writes the new state to a temporary file
+   * in the directory which is then renamed into place, so the state is never
+   * seen half-written. A receiver that can't take the lock within 100ms
+   * uploads its crash without deduplication or rate limiting.
+   */
+  ddog_CharSlice optional_state_dir;
+} ddog_prof_CrashDeduplication;
+
 typedef struct ddog_prof_CrashtrackerConfiguration {
   struct ddog_prof_Slice_CharSlice additional_files;
+  struct ddog_prof_AllThreadsCollection all_threads;
+  /**
+   * Size of the memory arena reserved at init, alongside the alt stack, from
+   * which all crash-time structures (frames, names, per-thread buffers of
+   * `all_threads`) are allocated. The crash handler never allocates otherwise;
+   * once the arena is exhausted, stacks are truncated. Zero picks a default
+   * sized from `all_threads`.
+   */
+  uintptr_t crash_arena_bytes;
   bool create_alt_stack;
+  struct ddog_prof_CrashDeduplication deduplication;
   /**
    * The endpoint to send the crash report to (can be a file://)
    *
@@ -177,7 +337,14 @@ typedef struct ddog_prof_CrashtrackerConfiguration {
    * the crashtracker will infer the agent host from env variables.
    */
   struct ddog_prof_Endpoint endpoint;
+  enum ddog_prof_CrashReportFormat report_format;
   enum ddog_prof_StacktraceCollection resolve_frames;
+  /**
+   * Time budget for in-process symbol resolution, counted from the start of
+   * crash handling. Zero means the budget is half of `timeout_secs`, so the
+   * remaining time is left for the receiver to emit the report.
+   */
+  uint64_t resolve_frames_budget_ms;
   uint64_t timeout_secs;
   bool wait_for_receiver;
 } ddog_prof_CrashtrackerConfiguration;
@@ -199,6 +366,30 @@ typedef struct ddog_prof_Slice_EnvVar {
   uintptr_t len;
 } ddog_prof_Slice_EnvVar;
 
+/**
+ * On-disk cache of the symbol tables a receiver extracts from ELF/DWARF, keyed
+ * by build ID, so that repeated crashes of the same binary don't parse debug
+ * info again. Binaries without a build ID are not cached.
+ *
+ * Several receivers may use the same directory at once, whether forked per
+ * process or shared. Each entry is written to a temporary file in the
+ * directory, then renamed into place, so readers only ever see complete
+ * entries and concurrent writers of the same build ID simply replace each
+ * other's identical entry. Eviction takes an advisory lock on a lock file in
+ * the directory; a receiver that can't take it immediately skips eviction.
+ */
+typedef struct ddog_prof_SymbolCacheConfig {
+  /**
+   * Directory of the cache. Empty disables the cache.
+   */
+  ddog_CharSlice optional_dir;
+  /**
+   * Size limit of the cache; least recently used entries are removed first.
+   * Zero means no limit.
+   */
+  uint64_t max_bytes;
+} ddog_prof_SymbolCacheConfig;
+
 typedef struct ddog_prof_CrashtrackerReceiverConfig {
   struct ddog_prof_Slice_CharSlice args;
   struct ddog_prof_Slice_EnvVar env;
@@ -211,6 +402,7 @@ typedef struct ddog_prof_CrashtrackerReceiverConfig {
    * Optional filename to forward stdout to (useful for logging/debugging)
    */
   ddog_CharSlice optional_stdout_filename;
+  struct ddog_prof_SymbolCacheConfig symbol_cache;
 } ddog_prof_CrashtrackerReceiverConfig;
 
 /**
@@ -223,6 +415,31 @@ typedef struct ddog_Vec_Tag {
   uintptr_t capacity;
 } ddog_Vec_Tag;
 
+/**
+ * Configuration of a shared receiver, see
+ * `ddog_prof_Crashtracker_receiver_daemon_entry_point`.
+ */
+typedef struct ddog_prof_CrashtrackerDaemonConfig {
+  ddog_CharSlice socket_path;
+  /**
+   * Connections beyond this number wait to be accepted. Zero means no limit.
+   */
+  uint32_t max_concurrent_connections;
+  struct ddog_prof_SymbolCacheConfig symbol_cache;
+} ddog_prof_CrashtrackerDaemonConfig;
+
+/**
+ * Timing of a profiling op, accumulated between matching calls to
+ * `ddog_prof_Crashtracker_begin_profiling_op` and
+ * `ddog_prof_Crashtracker_end_profiling_op`.
+ */
+typedef struct ddog_prof_ProfilingOpStats {
+  uint64_t count;
+  uint64_t total_us;
+  uint64_t max_us;
+  uint64_t histogram[ddog_prof_ProfilingOpStats_HISTOGRAM_BUCKETS];
+} ddog_prof_ProfilingOpStats;
+
 typedef struct ddog_prof_CrashtrackerMetadata {
   ddog_CharSlice profiling_library_name;
   ddog_CharSlice profiling_library_version;
@@ -349,6 +566,62 @@ typedef struct ddog_prof_StringWrapperResult {
   };
 } ddog_prof_StringWrapperResult;
 
+typedef enum ddog_prof_Demangler_NewResult_Tag {
+  DDOG_PROF_DEMANGLER_NEW_RESULT_OK,
+  DDOG_PROF_DEMANGLER_NEW_RESULT_ERR,
+} ddog_prof_Demangler_NewResult_Tag;
+
+typedef struct ddog_prof_Demangler_NewResult {
+  ddog_prof_Demangler_NewResult_Tag tag;
+  union {
+    struct {
+      struct ddog_prof_Demangler *ok;
+    };
+    struct {
+      struct ddog_Error err;
+    };
+  };
+} ddog_prof_Demangler_NewResult;
+
+/**
+ * A generic result type for when a demangler operation may fail, but there's
+ * nothing to return in the case of success.
+ */
+typedef enum ddog_prof_Demangler_Result_Tag {
+  DDOG_PROF_DEMANGLER_RESULT_OK,
+  DDOG_PROF_DEMANGLER_RESULT_ERR,
+} ddog_prof_Demangler_Result_Tag;
+
+typedef struct ddog_prof_Demangler_Result {
+  ddog_prof_Demangler_Result_Tag tag;
+  union {
+    struct {
+      /**
+       * Do not use the value of Ok. This value only exists to overcome
+       * Rust -> C code generation.
+       */
+      bool ok;
+    };
+    struct {
+      struct ddog_Error err;
+    };
+  };
+} ddog_prof_Demangler_Result;
+
+typedef struct ddog_prof_Demangler_Stats {
+  uint64_t cache_hits;
+  uint64_t cache_misses;
+  uint64_t cache_evictions;
+  /**
+   * Number of names currently cached.
+   */
+  uintptr_t cache_len;
+  /**
+   * Bytes currently held by the arena, including cached names.
+   */
+  uintptr_t arena_bytes;
+} ddog_prof_Demangler_Stats;
+
 typedef struct ddog_Slice_U8 {
   /**
    * Must be non-null and suitably aligned for the underlying type.
@@ -400,6 +673,105 @@ typedef struct ddog_prof_Exporter_NewResult {
   };
 } ddog_prof_Exporter_NewResult;
 
+/**
+ * Limits applied by an exporter to the uploads it performs. They are meant to
+ * avoid a fleet of processes flushing at the same second from saturating the
+ * node's uplink and the agent.
+ *
+ * A zero value for any field means "no limit" (or "no jitter").
+ */
+typedef struct ddog_prof_Exporter_UploadLimits {
+  /**
+   * Maximum number of `ddog_prof_Exporter_send` calls that may have a request
+   * on the wire at the same time. Extra calls wait for a slot to free up.
+   */
+  uint32_t max_concurrent_uploads;
+  /**
+   * Sustained upload rate, in bytes per second, of the token bucket shared by
+   * all sends of the exporter.
+   */
+  uint64_t max_bytes_per_second;
+  /**
+   * Capacity of the token bucket, in bytes. If zero while
+   * `max_bytes_per_second` is set, defaults to one second worth of tokens.
+   *
+   * A send waits until the bucket holds enough tokens for its body. A body
+   * larger than the bucket goes ahead as soon as the bucket is full, leaving
+   * the bucket in debt, so that later sends wait for it to refill.
+   */
+  uint64_t burst_bytes;
+  /**
+   * Each send is delayed by a random duration in [0, flush_jitter_ms] before
+   * the request is put on the wire. Should be at most the flush interval.
+   */
+  uint64_t flush_jitter_ms;
+} ddog_prof_Exporter_UploadLimits;
+
+/**
+ * Options used by an exporter whose endpoint was created with `ddog_Endpoint_file`.
+ *
+ * With the `LENGTH_PREFIXED` framing, rotation happens before writing a request
+ * that would make the current file exceed `max_file_bytes`, or once the current
+ * file is older than `max_file_age_secs`; a zero value disables the
+ * corresponding limit. With the `HTTP` framing, the file is rotated before
+ * every request and both limits are ignored.
+ * Rotated files get a numeric suffix, ".1" being the most recent.
+ */
+typedef struct ddog_prof_Exporter_FileOptions {
+  enum ddog_prof_Exporter_FileFraming framing;
+  uint64_t max_file_bytes;
+  uint64_t max_file_age_secs;
+  /**
+   * Number of rotated files to keep around; older ones are deleted.
+   * Zero keeps none: the current file is deleted instead of rotated, so that
+   * only the last request (or the current file) is on disk. This is the
+   * default, matching the behaviour of file endpoints without options.
+   */
+  uint32_t max_rotated_files;
+} ddog_prof_Exporter_FileOptions;
+
+/**
+ * A generic result type for when an exporter operation may fail, but there's
+ * nothing to return in the case of success.
+ */
+typedef enum ddog_prof_Exporter_Result_Tag {
+  DDOG_PROF_EXPORTER_RESULT_OK,
+  DDOG_PROF_EXPORTER_RESULT_ERR,
+} ddog_prof_Exporter_Result_Tag;
+
+typedef struct ddog_prof_Exporter_Result {
+  ddog_prof_Exporter_Result_Tag tag;
+  union {
+    struct {
+      /**
+       * Do not use the value of Ok. This value only exists to overcome
+       * Rust -> C code generation.
+       */
+      bool ok;
+    };
+    struct {
+      struct ddog_Error err;
+    };
+  };
+} ddog_prof_Exporter_Result;
+
+typedef enum ddog_prof_Exporter_Pipeline_NewResult_Tag {
+  DDOG_PROF_EXPORTER_PIPELINE_NEW_RESULT_OK,
+  DDOG_PROF_EXPORTER_PIPELINE_NEW_RESULT_ERR,
+} ddog_prof_Exporter_Pipeline_NewResult_Tag;
+
+typedef struct ddog_prof_Exporter_Pipeline_NewResult {
+  ddog_prof_Exporter_Pipeline_NewResult_Tag tag;
+  union {
+    struct {
+      struct ddog_prof_Exporter_Pipeline *ok;
+    };
+    struct {
+      struct ddog_Error err;
+    };
+  };
+} ddog_prof_Exporter_Pipeline_NewResult;
+
 typedef enum ddog_prof_Exporter_Request_BuildResult_Tag {
   DDOG_PROF_EXPORTER_REQUEST_BUILD_RESULT_OK,
   DDOG_PROF_EXPORTER_REQUEST_BUILD_RESULT_ERR,
@@ -425,6 +797,34 @@ typedef struct ddog_Timespec {
   uint32_t nanoseconds;
 } ddog_Timespec;
 
+/**
+ * One profile of a batch request, see `ddog_prof_Exporter_Request_build_batch`.
+ * The fields have the same meaning as the matching arguments of
+ * `ddog_prof_Exporter_Request_build`.
+ */
+typedef struct ddog_prof_Exporter_BatchEntry {
+  struct ddog_Timespec start;
+  struct ddog_Timespec end;
+  struct ddog_prof_Exporter_Slice_File files_to_compress_and_export;
+  struct ddog_prof_Exporter_Slice_File files_to_export_unmodified;
+  const struct ddog_Vec_Tag *optional_additional_tags;
+  const struct ddog_prof_ProfiledEndpointsStats *optional_endpoints_stats;
+  const ddog_CharSlice *optional_internal_metadata_json;
+  const ddog_CharSlice *optional_info_json;
+} ddog_prof_Exporter_BatchEntry;
+
+typedef struct ddog_prof_Exporter_Slice_BatchEntry {
+  /**
+   * Must be non-null and suitably aligned for the underlying type.
+   */
+  const struct ddog_prof_Exporter_BatchEntry *ptr;
+  /**
+   * The number of elements (not bytes) that `.ptr` points to. Must be less
+   * than or equal to [isize::MAX].
+   */
+  uintptr_t len;
+} ddog_prof_Exporter_Slice_BatchEntry;
+
 typedef struct ddog_HttpStatus {
   uint16_t code;
 } ddog_HttpStatus;
@@ -446,6 +846,93 @@ typedef struct ddog_prof_Exporter_SendResult {
   };
 } ddog_prof_Exporter_SendResult;
 
+typedef enum ddog_prof_Exporter_Pipeline_SubmitResult_Tag {
+  /**
+   * The pipeline took ownership of the request and will send it.
+   */
+  DDOG_PROF_EXPORTER_PIPELINE_SUBMIT_RESULT_ACCEPTED,
+  /**
+   * The queue is at `max_queue_depth`; the request was left untouched, and
+   * the caller decides whether to retry later or drop it.
+   */
+  DDOG_PROF_EXPORTER_PIPELINE_SUBMIT_RESULT_QUEUE_FULL,
+  DDOG_PROF_EXPORTER_PIPELINE_SUBMIT_RESULT_ERR,
+} ddog_prof_Exporter_Pipeline_SubmitResult_Tag;
+
+typedef struct ddog_prof_Exporter_Pipeline_SubmitResult {
+  ddog_prof_Exporter_Pipeline_SubmitResult_Tag tag;
+  union {
+    struct {
+      struct ddog_Error err;
+    };
+  };
+} ddog_prof_Exporter_Pipeline_SubmitResult;
+
+typedef struct ddog_prof_Exporter_Pipeline_Status {
+  /**
+   * Requests waiting to be sent, not counting the one in flight.
+   */
+  uintptr_t queued;
+  bool in_flight;
+  uint64_t completed;
+  /**
+   * Sends that ended in an error (not counting non-2xx HTTP statuses).
+   */
+  uint64_t failed;
+  /**
+   * Submissions refused with `QUEUE_FULL`.
+   */
+  uint64_t rejected;
+  /**
+   * Status of the last completed send, or 0 if none completed yet.
+   */
+  struct ddog_HttpStatus last_http_status;
+} ddog_prof_Exporter_Pipeline_Status;
+
+/**
+ * Summary of a distribution of durations, in microseconds. Percentiles are
+ * estimated with a relative accuracy of 1%.
+ */
+typedef struct ddog_prof_Exporter_Histogram {
+  uint64_t count;
+  uint64_t sum_us;
+  uint64_t min_us;
+  uint64_t max_us;
+  uint64_t p50_us;
+  uint64_t p99_us;
+} ddog_prof_Exporter_Histogram;
+
+/**
+ * Counters and histograms accumulated by an exporter since it was created, or
+ * since the last `ddog_prof_Exporter_reset_metrics`.
+ */
+typedef struct ddog_prof_Exporter_Metrics {
+  uint64_t requests_built;
+  uint64_t requests_sent;
+  /**
+   * Sends that ended with an error rather than an HTTP status.
+   */
+  uint64_t requests_failed;
+  /**
+   * Sends interrupted through `ddog_CancellationToken_cancel`.
+   */
+  uint64_t cancellations;
+  /**
+   * Size of `files_to_compress_and_export` before and after compression.
+   */
+  uint64_t bytes_uncompressed;
+  uint64_t bytes_compressed;
+  /**
+   * Size of the request bodies put on the wire.
+   */
+  uint64_t bytes_sent;
+  uint64_t connections_opened;
+  uint64_t connections_reused;
+  struct ddog_prof_Exporter_Histogram build_time;
+  struct ddog_prof_Exporter_Histogram time_to_first_byte;
+  struct ddog_prof_Exporter_Histogram send_time;
+} ddog_prof_Exporter_Metrics;
+
 /**
  * Represents a profile. Do not access its member for any reason, only use
  * the C API functions on this struct.
@@ -551,6 +1038,9 @@ typedef struct ddog_prof_Mapping {
 typedef struct ddog_prof_Function {
   /**
    * Name of the function, in human-readable form if available.
+   * May be left empty when lazy demangling is enabled, see
+   * `ddog_prof_Profile_set_lazy_demangling`; it is then filled in from
+   * `system_name`.
    */
   ddog_CharSlice name;
   /**
@@ -726,9 +1216,9 @@ DDOG_CHECK_RETURN struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_shu
  * chance that a crash occurs between the fork, and this call.
  * In particular, reset the counters that track the profiler state machine,
  * and start a new receiver to collect data from this fork.
- * NOTE: An alternative design would be to have a 1:many sidecar listening on a
- * socket instead of 1:1 receiver listening on a pipe, but the only real
- * advantage would be to have fewer processes in `ps -a`.
+ * Processes sharing a receiver should instead use
+ * `ddog_prof_Crashtracker_update_on_fork_with_unix_socket`, which doesn't
+ * start anything.
  *
  * # Preconditions
  *     This function assumes that the crash-tracker has previously been
@@ -777,6 +1267,26 @@ struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_receiver_entry_point_
 DDOG_CHECK_RETURN
 struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_receiver_entry_point_unix_socket(ddog_CharSlice socket_path);
 
+/**
+ * Runs a receiver shared by every process on the host that was initialized
+ * with `ddog_prof_Crashtracker_init_with_unix_socket`, instead of each process
+ * forking its own.
+ *
+ * Listens on `config.socket_path`, and for each connection receives data from
+ * a crash collector, formats it into `CrashInfo` json, and emits it to the
+ * endpoint/file defined in the `config` sent by that collector. Connections
+ * are handled concurrently, up to `config.max_concurrent_connections`. Unlike
+ * `ddog_prof_Crashtracker_receiver_entry_point_unix_socket`, this function
+ * keeps serving and only returns on error.
+ *
+ * See comments in [profiling/crashtracker/mod.rs] for a full architecture
+ * description.
+ * # Safety
+ * No safety concerns
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_receiver_daemon_entry_point(struct ddog_prof_CrashtrackerDaemonConfig config);
+
 /**
  * Initialize the crash-tracking infrastructure.
  *
@@ -795,7 +1305,54 @@ struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_init_with_receiver(st
                                                                               struct ddog_prof_CrashtrackerMetadata metadata);
 
 /**
- * Resets all counters to 0.
+ * Initialize the crash-tracking infrastructure, reporting crashes to an
+ * already running receiver listening on `socket_path` (see
+ * `ddog_prof_Crashtracker_receiver_daemon_entry_point`) instead of
+ * starting one.
+ *
+ * No connection is kept open: the crash handler only connects to the socket
+ * once a crash occurs, and then hands over the crash data, `config` and
+ * `metadata`.
+ *
+ * # Preconditions
+ *     None.
+ * # Safety
+ *     Crash-tracking functions are not reentrant.
+ *     No other crash-handler functions should be called concurrently.
+ * # Atomicity
+ *     This function is not atomic. A crash during its execution may lead to
+ *     unexpected crash-handling behaviour.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_init_with_unix_socket(struct ddog_prof_CrashtrackerConfiguration config,
+                                                                                 ddog_CharSlice socket_path,
+                                                                                 struct ddog_prof_CrashtrackerMetadata metadata);
+
+/**
+ * Reinitialize the crash-tracking infrastructure after a fork, for a process
+ * initialized with `ddog_prof_Crashtracker_init_with_unix_socket`.
+ * This should be one of the first things done after a fork, to minimize the
+ * chance that a crash occurs between the fork, and this call.
+ * In particular, reset the counters that track the profiler state machine.
+ * Unlike `ddog_prof_Crashtracker_update_on_fork`, no receiver is started.
+ *
+ * # Preconditions
+ *     This function assumes that the crash-tracker has previously been
+ *     initialized.
+ * # Safety
+ *     Crash-tracking functions are not reentrant.
+ *     No other crash-handler functions should be called concurrently.
+ * # Atomicity
+ *     This function is not atomic. A crash during its execution may lead to
+ *     unexpected crash-handling behaviour.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_update_on_fork_with_unix_socket(struct ddog_prof_CrashtrackerConfiguration config,
+                                                                                           ddog_CharSlice socket_path,
+                                                                                           struct ddog_prof_CrashtrackerMetadata metadata);
+
+/**
+ * Resets all counters to 0, including the timing of profiling ops.
  * Expected to be used after a fork, to reset the counters on the child
  * ATOMICITY:
  *     This is NOT ATOMIC.
@@ -809,6 +1366,7 @@ DDOG_CHECK_RETURN struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_res
 /**
  * Atomically increments the count associated with `op`.
  * Useful for tracking what operations were occuring when a crash occurred.
+ * Also records the start time of `op` on the calling thread.
  *
  * # Safety
  * No safety concerns.
@@ -819,6 +1377,9 @@ struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_begin_profiling_op(en
 /**
  * Atomically decrements the count associated with `op`.
  * Useful for tracking what operations were occuring when a crash occurred.
+ * Also adds the time elapsed since the matching begin on the calling thread to
+ * the stats of `op`. Nested begins of the same `op` on a thread are timed from
+ * the outermost one.
  *
  * # Safety
  * No safety concerns.
@@ -826,6 +1387,20 @@ struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_begin_profiling_op(en
 DDOG_CHECK_RETURN
 struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_end_profiling_op(enum ddog_prof_ProfilingOpTypes op);
 
+/**
+ * Writes into `stats` the timing accumulated for `op` by all threads since
+ * init or the last `ddog_prof_Crashtracker_reset_counters`.
+ * Each thread updates its own lock-free counters, which this sums up, so
+ * begin/end stay cheap enough to be always on. The same stats are included in
+ * crash reports.
+ *
+ * # Safety
+ * `stats` must be a valid pointer to a `ddog_prof_ProfilingOpStats`.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_CrashtrackerResult ddog_prof_Crashtracker_profiling_op_stats(enum ddog_prof_ProfilingOpTypes op,
+                                                                              struct ddog_prof_ProfilingOpStats *stats);
+
 /**
  * Create a new crashinfo, and returns an opaque reference to it.
  * # Safety
@@ -942,8 +1517,11 @@ DDOG_CHECK_RETURN
 struct ddog_prof_CrashtrackerResult ddog_crashinfo_set_timestamp_to_now(struct ddog_prof_CrashInfo *crashinfo);
 
 /**
- * Exports `crashinfo` to the backend at `endpoint`
+ * Exports `crashinfo` to the backend at `endpoint`, encoded as per
+ * `config.report_format`.
  * Note that we support the "file://" endpoint for local file output.
+ * Returns an error if `config.report_format` is `COMPACT` and the endpoint is
+ * not a file.
  * # Safety
  * `crashinfo` must be a valid pointer to a `CrashInfo` object.
  */
@@ -963,6 +1541,54 @@ DDOG_CHECK_RETURN
 struct ddog_prof_StringWrapperResult ddog_demangle(ddog_CharSlice name,
                                                    enum ddog_prof_DemangleOptions options);
 
+/**
+ * Creates a demangler for use with `ddog_prof_Demangler_demangle_batch`.
+ *
+ * # Arguments
+ * * `options` - Used for every name demangled by this demangler.
+ * * `cache_capacity` - Maximum number of names kept in the cache; the least recently used ones
+ *   are evicted first. Zero disables caching.
+ *
+ * # Safety
+ * No safety issues.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Demangler_NewResult ddog_prof_Demangler_new(enum ddog_prof_DemangleOptions options,
+                                                             uintptr_t cache_capacity);
+
+/**
+ * # Safety
+ * The `demangler` can be null, but if non-null it must point to a Demangler
+ * made by this module, which has not previously been dropped.
+ */
+void ddog_prof_Demangler_drop(struct ddog_prof_Demangler *demangler);
+
+/**
+ * Demangles each of `names`, writing the result for `names.ptr[i]` into
+ * `out_names[i]`. As with `ddog_demangle`, names that fail to demangle result
+ * in an empty string.
+ *
+ * The results point into the demangler's arena, and are valid until the next
+ * call to this function with the same demangler, or until it is dropped.
+ * Names found in the cache are neither demangled nor copied again.
+ *
+ * # Safety
+ * `demangler` must be a valid pointer to a `Demangler` object.
+ * `names` should only contain valid references to utf8 encoded Strings.
+ * `out_names` must point to at least `names.len` writable elements.
+ * This call is _NOT_ thread-safe.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Demangler_Result ddog_prof_Demangler_demangle_batch(struct ddog_prof_Demangler *demangler,
+                                                                     struct ddog_prof_Slice_CharSlice names,
+                                                                     ddog_CharSlice *out_names);
+
+/**
+ * # Safety
+ * `demangler` must be a valid pointer to a `Demangler` object.
+ */
+struct ddog_prof_Demangler_Stats ddog_prof_Demangler_stats(const struct ddog_prof_Demangler *demangler);
+
 DDOG_CHECK_RETURN struct ddog_prof_Exporter_Slice_File ddog_prof_Exporter_Slice_File_empty(void);
 
 /**
@@ -982,8 +1608,9 @@ struct ddog_prof_Endpoint ddog_prof_Endpoint_agentless(ddog_CharSlice site, ddog
 
 /**
  * Creates an endpoint that writes to a file.
- * Useful for local debugging.
- * Currently only supported by the crashtracker.
+ * Useful for local debugging, and for benchmarking export without a network.
+ * Supported by the crashtracker and the profile exporter; for the latter, see
+ * `ddog_prof_Exporter_set_file_options` for rotation and framing.
  * # Arguments
  * * `filename` - Path to the output file "/tmp/file.txt".
  */
@@ -1021,6 +1648,58 @@ struct ddog_prof_Exporter_NewResult ddog_prof_Exporter_new(ddog_CharSlice profil
  */
 void ddog_prof_Exporter_drop(struct ddog_prof_Exporter *exporter);
 
+/**
+ * Returns a snapshot of the exporter's metrics. The counters are updated with
+ * relaxed atomics, so this can be called from any thread, including while a
+ * send is in progress; the snapshot is not guaranteed to be consistent across
+ * fields.
+ *
+ * # Safety
+ * The `exporter` must point to a valid `ddog_prof_Exporter` made by this module.
+ */
+struct ddog_prof_Exporter_Metrics ddog_prof_Exporter_metrics(const struct ddog_prof_Exporter *exporter);
+
+/**
+ * Resets all the metrics of the exporter to zero, e.g. after having reported
+ * them, to get per-interval values.
+ *
+ * # Safety
+ * The `exporter` must point to a valid `ddog_prof_Exporter` made by this module.
+ */
+void ddog_prof_Exporter_reset_metrics(const struct ddog_prof_Exporter *exporter);
+
+/**
+ * Sets the upload limits used by all subsequent `ddog_prof_Exporter_send`
+ * calls made with this exporter. Sends already in progress are not affected.
+ *
+ * # Arguments
+ * * `exporter` - Borrows the exporter to configure.
+ * * `limits` - Limits to apply; see `ddog_prof_Exporter_UploadLimits`. Passing a zeroed struct
+ *   removes all limits, which is also the default for a new exporter.
+ *
+ * # Safety
+ * The `exporter` must point to a valid `ddog_prof_Exporter` made by this module.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Exporter_Result ddog_prof_Exporter_set_upload_limits(struct ddog_prof_Exporter *exporter,
+                                                                      struct ddog_prof_Exporter_UploadLimits limits);
+
+/**
+ * Sets how the exporter writes requests when its endpoint is a file.
+ * Sending to a file endpoint reports an HTTP status of 200 on success.
+ * Returns an error if the exporter was not created with a file endpoint.
+ *
+ * # Arguments
+ * * `exporter` - Borrows the exporter to configure.
+ * * `options` - Framing and rotation options; see `ddog_prof_Exporter_FileOptions`.
+ *
+ * # Safety
+ * The `exporter` must point to a valid `ddog_prof_Exporter` made by this module.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Exporter_Result ddog_prof_Exporter_set_file_options(struct ddog_prof_Exporter *exporter,
+                                                                     struct ddog_prof_Exporter_FileOptions options);
+
 /**
  * If successful, builds a `ddog_prof_Exporter_Request` object based on the
  * profile data supplied. If unsuccessful, it returns an error message.
@@ -1033,6 +1712,9 @@ void ddog_prof_Exporter_drop(struct ddog_prof_Exporter *exporter);
  * For details on the `optional_info_json`, please reference the Datadog-internal
  * "RFC: Pprof System Info Support".
  *
+ * Only needs a shared borrow of the exporter, so it can be called while a
+ * `ddog_prof_Exporter_Pipeline` sends with the same exporter on another thread.
+ *
  * # Safety
  * The `exporter`, `optional_additional_stats`, and `optional_endpoint_stats` args should be
  * valid objects created by this module.
@@ -1040,7 +1722,7 @@ void ddog_prof_Exporter_drop(struct ddog_prof_Exporter *exporter);
  * `optional_internal_metadata_json` and `optional_info_json`.
  */
 DDOG_CHECK_RETURN
-struct ddog_prof_Exporter_Request_BuildResult ddog_prof_Exporter_Request_build(struct ddog_prof_Exporter *exporter,
+struct ddog_prof_Exporter_Request_BuildResult ddog_prof_Exporter_Request_build(const struct ddog_prof_Exporter *exporter,
                                                                                struct ddog_Timespec start,
                                                                                struct ddog_Timespec end,
                                                                                struct ddog_prof_Exporter_Slice_File files_to_compress_and_export,
@@ -1051,6 +1733,35 @@ struct ddog_prof_Exporter_Request_BuildResult ddog_prof_Exporter_Request_build(s
                                                                                const ddog_CharSlice *optional_info_json,
                                                                                uint64_t timeout_ms);
 
+/**
+ * If successful, builds a single `ddog_prof_Exporter_Request` carrying all the
+ * profiles in `entries`, so that headers, connection setup and intake
+ * processing are paid once for the whole batch. If unsuccessful, it returns
+ * an error message.
+ *
+ * Each entry becomes its own event in the multipart body, with its own files,
+ * time range and tags; the exporter's tags apply to all of them. On the wire,
+ * entry `i` (counting from 0) is sent as:
+ * * a form-data part named "event.<i>" with filename "event.json", holding the
+ *   same event json as `ddog_prof_Exporter_Request_build` produces;
+ * * one form-data part per file, named "<i>/<file name>", whose filename is
+ *   the file name; the event's "attachments" list these part names.
+ * File names thus only need to be unique within an entry. The request is sent
+ * with the `DD-EVP-BATCH: true` header, and the intake rejects the whole
+ * request if any event is invalid. The resulting request is sent like any
+ * other, e.g. with `ddog_prof_Exporter_send`. Returns an error if `entries` is
+ * empty.
+ *
+ * # Safety
+ * The `exporter` and every `optional_endpoints_stats` of `entries` should be valid objects created
+ * by this module. The optional pointers of each entry follow the same rules as the arguments of
+ * `ddog_prof_Exporter_Request_build`.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Exporter_Request_BuildResult ddog_prof_Exporter_Request_build_batch(const struct ddog_prof_Exporter *exporter,
+                                                                                     struct ddog_prof_Exporter_Slice_BatchEntry entries,
+                                                                                     uint64_t timeout_ms);
+
 /**
  * # Safety
  * Each pointer of `request` may be null, but if non-null the inner-most
@@ -1059,6 +1770,82 @@ struct ddog_prof_Exporter_Request_BuildResult ddog_prof_Exporter_Request_build(s
  */
 void ddog_prof_Exporter_Request_drop(struct ddog_prof_Exporter_Request **request);
 
+/**
+ * Creates a pipeline that sends requests built for `exporter` on a background
+ * thread, keeping at most `max_queue_depth` requests waiting behind the one in
+ * flight.
+ *
+ * # Arguments
+ * * `exporter` - Borrows the exporter used for sending. It must outlive the pipeline.
+ * * `max_queue_depth` - Must be at least 1.
+ *
+ * # Thread safety
+ * The pipeline only holds a shared (const) borrow of `exporter`, as do
+ * `ddog_prof_Exporter_Request_build` and `ddog_prof_Exporter_Request_build_batch`, so requests can
+ * be built on another thread while the pipeline sends: the state they touch (upload limits,
+ * metrics, connection pool) is internally synchronized. Functions taking a mutable exporter, such
+ * as `ddog_prof_Exporter_send` and the `set_*` functions, must not be called on it while the
+ * pipeline exists.
+ *
+ * # Safety
+ * The `exporter` must point to a valid `ddog_prof_Exporter` made by this module.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Exporter_Pipeline_NewResult ddog_prof_Exporter_Pipeline_new(const struct ddog_prof_Exporter *exporter,
+                                                                             uintptr_t max_queue_depth);
+
+/**
+ * Queues the request to be sent without waiting for it, nor for previously
+ * submitted ones, to go out.
+ *
+ * # Arguments
+ * * `pipeline` - Borrows the pipeline.
+ * * `request` - On `ACCEPTED`, ownership of the request is taken and it is replaced with a null
+ *   pointer. On any other result it is left untouched.
+ * * `cancel` - Borrows the cancel, if any. On `ACCEPTED`, the pipeline keeps its own clone of the
+ *   token (see `ddog_CancellationToken_clone`) until the request is sent, so the caller may drop
+ *   `cancel` as soon as this returns. Cancelling it, or any other clone, interrupts this request's
+ *   send, whether it is still queued or already in flight.
+ *
+ * # Safety
+ * All non-null arguments MUST have been created by created by apis in this module.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Exporter_Pipeline_SubmitResult ddog_prof_Exporter_Pipeline_submit(struct ddog_prof_Exporter_Pipeline *pipeline,
+                                                                                   struct ddog_prof_Exporter_Request **request,
+                                                                                   const struct ddog_CancellationToken *cancel);
+
+/**
+ * Returns a snapshot of the pipeline's queue and counters. Cheap enough to be
+ * called on every flush to decide whether to skip or downsample a profile.
+ *
+ * # Safety
+ * The `pipeline` must point to a valid `ddog_prof_Exporter_Pipeline`.
+ */
+struct ddog_prof_Exporter_Pipeline_Status ddog_prof_Exporter_Pipeline_status(const struct ddog_prof_Exporter_Pipeline *pipeline);
+
+/**
+ * Blocks until every submitted request was sent, or `timeout_ms` elapsed, in
+ * which case an error is returned and the remaining requests stay queued.
+ *
+ * # Safety
+ * The `pipeline` must point to a valid `ddog_prof_Exporter_Pipeline`.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Exporter_Result ddog_prof_Exporter_Pipeline_drain(struct ddog_prof_Exporter_Pipeline *pipeline,
+                                                                   uint64_t timeout_ms);
+
+/**
+ * Stops the background thread, cancelling the request in flight and dropping
+ * queued ones. Use `ddog_prof_Exporter_Pipeline_drain` first to avoid losing
+ * data.
+ *
+ * # Safety
+ * The `pipeline` may be null, but if non-null the pointer must point to a
+ * valid `ddog_prof_Exporter_Pipeline` object that has not already been dropped.
+ */
+void ddog_prof_Exporter_Pipeline_drop(struct ddog_prof_Exporter_Pipeline *pipeline);
+
 /**
  * Sends the request, returning the HttpStatus.
  *
@@ -1068,6 +1855,11 @@ void ddog_prof_Exporter_Request_drop(struct ddog_prof_Exporter_Request **request
  *   takes a double-pointer, rather than a single one.
  * * `cancel` - Borrows the cancel, if any.
  *
+ * If upload limits were set with `ddog_prof_Exporter_set_upload_limits`, this call may first wait
+ * for the flush jitter, a free upload slot and enough bandwidth tokens. These waits happen before
+ * the request's `timeout_ms` starts counting, which only covers the HTTP exchange. Cancelling
+ * `cancel` also interrupts these waits.
+ *
  * # Safety
  * All non-null arguments MUST have been created by created by apis in this module.
  */
@@ -1170,6 +1962,36 @@ struct ddog_prof_Profile_Result ddog_prof_Profile_add(struct ddog_prof_Profile *
                                                       struct ddog_prof_Sample sample,
                                                       int64_t timestamp);
 
+/**
+ * Makes the profile fill in the `name` of functions from their mangled
+ * `system_name` when the profile is serialized, instead of requiring callers
+ * to demangle every frame before `ddog_prof_Profile_add`.
+ *
+ * The profile owns a `ddog_prof_Demangler`, whose cache survives serializations
+ * and resets. Each unique function is thus demangled once, the first time it
+ * is serialized; on later flushes, steady-state stacks are served from the
+ * cache. Functions added with a non-empty `name` are left as-is.
+ * When demangling fails, e.g. for plain C symbols such as `main` or `malloc`
+ * which are not mangled, `system_name` is copied verbatim as the `name`,
+ * rather than leaving it empty as `ddog_demangle` would.
+ *
+ * # Arguments
+ * * `profile` - a reference to the profile that will contain the samples.
+ * * `options` - how to demangle names; applies to this profile only.
+ * * `cache_capacity` - as for `ddog_prof_Demangler_new`. Zero disables caching, so that names are
+ *   demangled again on every serialization.
+ *
+ * # Safety
+ * This function must be called before adding samples and must not be called after.
+ * The `profile` ptr must point to a valid Profile object created by this
+ * module.
+ * This call is _NOT_ thread-safe.
+ */
+DDOG_CHECK_RETURN
+struct ddog_prof_Profile_Result ddog_prof_Profile_set_lazy_demangling(struct ddog_prof_Profile *profile,
+                                                                      enum ddog_prof_DemangleOptions options,
+                                                                      uintptr_t cache_capacity);
+
 /**
  * Associate an endpoint to a given local root span id.
  * During the serialization of the profile, an endpoint label will be added
@@ -1280,6 +2102,7 @@ void ddog_prof_EncodedProfile_drop(struct ddog_prof_EncodedProfile *profile);
 /**
  * Serialize the aggregated profile.
  * Drains the data, and then resets the profile for future use.
+ * If lazy demangling is enabled, function names are demangled at this point.
  *
  * Don't forget to clean up the ok with `ddog_prof_EncodedProfile_drop` or
  * the error variant with `ddog_Error_drop` when you are done with them.